@@ -15,4 +15,40 @@ global _get_EFLAGS
 _get_EFLAGS:
 	pushfd			; push eflags
 	pop	eax		; pop contents into eax
-	ret
\ No newline at end of file
+	ret
+
+; ----------------------------------------------------------------------
+; insw_block(unsigned short port, void * buf, unsigned long count)
+;
+; Reads count 16-bit words from the given port into buf (REP INSW).
+;
+; ----------------------------------------------------------------------
+global _insw_block
+; this function is exported.
+_insw_block:
+	push	edi
+	mov	edx, [esp+8]	; port
+	mov	edi, [esp+12]	; buf
+	mov	ecx, [esp+16]	; count
+	cld
+	rep	insw
+	pop	edi
+	ret
+
+; ----------------------------------------------------------------------
+; outsw_block(unsigned short port, const void * buf, unsigned long count)
+;
+; Writes count 16-bit words from buf to the given port (REP OUTSW).
+;
+; ----------------------------------------------------------------------
+global _outsw_block
+; this function is exported.
+_outsw_block:
+	push	esi
+	mov	edx, [esp+8]	; port
+	mov	esi, [esp+12]	; buf
+	mov	ecx, [esp+16]	; count
+	cld
+	rep	outsw
+	pop	esi
+	ret
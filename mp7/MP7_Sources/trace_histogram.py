@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Turn the trace records in a Bochs/QEMU port 0xE9 log into per-function
+latency histograms.
+
+The kernel writes its trace (see trace.H) to port 0xE9, mixed in with the
+console output. Capture it with "port_e9_hack: enabled=1" in bochsrc.bxrc
+(Bochs prints it to its console) or with "-debugcon file:e9.log" in QEMU,
+then run
+
+    python3 trace_histogram.py e9.log
+
+Every ENTER record is matched with the next EXIT record of the same event in
+the same context (thread). Latencies are shown in microseconds if the log
+contains two clock records (@C) to calibrate the TSC against the timer, and
+in TSC cycles otherwise.
+"""
+
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+RECORD = re.compile(r"@([NCTD]) ([^@\r\n]*)")
+
+
+def parse(lines):
+    names = {}
+    clocks = []
+    spans = defaultdict(list)   # event -> [cycles]
+    marks = defaultdict(int)    # event -> count
+    open_spans = defaultdict(list)
+    dropped = 0
+    unmatched = 0
+
+    for line in lines:
+        for tag, fields in RECORD.findall(line):
+            f = fields.split()
+            try:
+                if tag == "N":
+                    names[int(f[0])] = " ".join(f[1:])
+                elif tag == "C":
+                    clocks.append((int(f[0]), int(f[1], 16)))
+                elif tag == "D":
+                    dropped += int(f[0])
+                elif tag == "T":
+                    tsc, kind, context, event = int(f[0], 16), f[1], int(f[2]), int(f[3])
+                    key = (context, event)
+                    if kind == "E":
+                        open_spans[key].append(tsc)
+                    elif kind == "X":
+                        if open_spans[key]:
+                            spans[event].append(tsc - open_spans[key].pop())
+                        else:
+                            unmatched += 1
+                    else:
+                        marks[event] += 1
+            except (IndexError, ValueError):
+                continue  # A record cut up by other output
+
+    unmatched += sum(len(s) for s in open_spans.values())
+    return names, clocks, spans, marks, dropped, unmatched
+
+
+def cycles_per_us(clocks, hz):
+    """TSC frequency from the first and last clock record, if they differ."""
+    if len(clocks) < 2:
+        return None
+    (t0, c0), (t1, c1) = clocks[0], clocks[-1]
+    if t1 <= t0 or c1 <= c0:
+        return None
+    return (c1 - c0) / ((t1 - t0) * 1e6 / hz)
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def print_histogram(name, cycles, scale, unit, width):
+    cycles.sort()
+    values = [c / scale for c in cycles]
+    print("%s: %d calls, min %.1f, avg %.1f, p50 %.1f, p99 %.1f, max %.1f %s"
+          % (name, len(values), values[0], sum(values) / len(values),
+             percentile(values, 50), percentile(values, 99), values[-1], unit))
+
+    # Power-of-two buckets
+    buckets = defaultdict(int)
+    for v in values:
+        b = 0
+        while (1 << b) <= v:
+            b += 1
+        buckets[b] += 1
+    top = max(buckets.values())
+    for b in range(min(buckets), max(buckets) + 1):
+        low = 0 if b == 0 else 1 << (b - 1)
+        n = buckets.get(b, 0)
+        bar = "#" * ((n * width + top - 1) // top)
+        print("  %10d .. %-10d %s %8d %s" % (low, (1 << b) - 1, unit, n, bar))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0].strip(),
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", help="0xE9 log (default: stdin)")
+    parser.add_argument("--hz", type=int, default=100,
+                        help="timer frequency of the kernel (default: 100)")
+    parser.add_argument("--cycles", action="store_true",
+                        help="report TSC cycles even if the log can be calibrated")
+    parser.add_argument("--width", type=int, default=50, help="width of the bars")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, errors="replace") as log:
+            names, clocks, spans, marks, dropped, unmatched = parse(log)
+    else:
+        names, clocks, spans, marks, dropped, unmatched = parse(sys.stdin)
+
+    rate = None if args.cycles else cycles_per_us(clocks, args.hz)
+    scale, unit = (rate, "us") if rate else (1, "cycles")
+    if rate:
+        print("TSC: %.0f MHz (from %d clock records)\n" % (rate, len(clocks)))
+
+    for event in sorted(spans, key=lambda e: -sum(spans[e])):
+        print_histogram(names.get(event, "event %d" % event), spans[event], scale, unit, args.width)
+
+    for event in sorted(marks):
+        print("%s: %d events" % (names.get(event, "event %d" % event), marks[event]))
+    if dropped or unmatched:
+        print("\n%d records dropped by the kernel, %d entries/exits without a partner"
+              % (dropped, unmatched))
+
+
+if __name__ == "__main__":
+    main()